@@ -81,21 +81,24 @@ namespace allradixsort
 	};
 
 
-	// Sorts [fbegin, fend) using insertion sort with the given key extraction function.
-	template<class KeyType, class Iter, class GetKeyFn>
-	void float_sort(Iter begin, Iter end, GetKeyFn get_key)
+	// Creating histograms, count each occurrence of indexed-byte value.
+	// In particular, histograms don't change when you change the order, 
+	// so I just do all the histogramming in one pass through the data. One read builds several histograms.
+	// The keys are flipped in place, they should be restored with float_flip_inv afterwards.
+	template<class KeyType, class Iter, class GetKeyFn, class IndexType>
+	void float_histograms(Iter begin, Iter end, GetKeyFn get_key, basic_hists_vector<IndexType>& hist)
 	{
 		constexpr size_t num_passes = traits<KeyType>::num_passes;
 		constexpr size_t bits_in_mask = traits<KeyType>::bits_in_mask;
 		constexpr size_t mask = traits<KeyType>::mask;
 		constexpr size_t num_bins = traits<KeyType>::num_bins;
-		size_t size = end - begin;
 
-		using hists_vector = std::vector<std::vector<index_t>>;
-		// Creating histograms, count each occurrence of indexed-byte value.
-		// In particular, histograms don't change when you change the order, 
-		// so I just do all the histogramming in one pass through the data. One read builds several histograms.
-		hists_vector hist{ num_passes, std::vector<index_t>(num_bins) };
+		// reuse the memory of the given histograms
+		hist.resize(num_passes);
+		for (auto& pass_hist : hist)
+		{
+			pass_hist.assign(num_bins, 0);
+		}
 		for (Iter it = begin; it != end; ++it)
 		{
 			auto key = float_flip<KeyType, typename traits<KeyType>::proxy_type>(get_key(*it));
@@ -107,12 +110,19 @@ namespace allradixsort
 				++hist[pass][pass_hist_val];
 			}
 		}
+	}
+
+	// accumulate histograms.
+	// generate positional offsets.
+	template<class KeyType, class IndexType>
+	void float_offsets(basic_hists_vector<IndexType>& hist)
+	{
+		constexpr size_t num_passes = traits<KeyType>::num_passes;
+		constexpr size_t num_bins = traits<KeyType>::num_bins;
 
-		// accumulate histograms.
-		// generate positional offsets. adjust starting point if signed.
 		for (size_t pass = 0; pass < num_passes; ++pass)
 		{
-			index_t tsum, sum = 0;
+			IndexType tsum, sum = 0;
 			for (size_t i = 0; i < num_bins; ++i)
 			{
 				tsum = hist[pass][i] + sum;
@@ -120,12 +130,29 @@ namespace allradixsort
 				sum = tsum;
 			}
 		}
+	}
+
+	// Sorts [fbegin, fend) using insertion sort with the given key extraction function.
+	// hist and buffer are scratch memory, which can be reused between calls.
+	template<class KeyType, class Iter, class GetKeyFn, class IndexType>
+	void float_sort(Iter begin, Iter end, GetKeyFn get_key, basic_hists_vector<IndexType>& hist, std::vector<cont_type_t<Iter>>& buffer)
+	{
+		constexpr size_t num_passes = traits<KeyType>::num_passes;
+		constexpr size_t bits_in_mask = traits<KeyType>::bits_in_mask;
+		constexpr size_t mask = traits<KeyType>::mask;
+		size_t size = end - begin;
+
+		float_histograms<KeyType>(begin, end, get_key, hist);
+		float_offsets<KeyType>(hist);
 
 		// distribute.
 		// stable reordering of elements. backward to avoid shifting
 		// the counter array.
 		// temp buffer to hold values in odd passes
-		std::vector<cont_type_t<Iter>> buffer(size);
+		if (buffer.size() < size) {
+			buffer.resize(size);
+		}
+		auto buffer_end = buffer.begin() + size;
 
 		for (size_t pass = 0; pass < num_passes;)
 		{
@@ -143,7 +170,7 @@ namespace allradixsort
 
 			// use input container as a buffer
 			if (pass == num_passes - 1) {
-				for (auto it = buffer.begin(); it != buffer.end(); ++it)
+				for (auto it = buffer.begin(); it != buffer_end; ++it)
 				{
 					auto key = *reinterpret_cast<typename traits<KeyType>::proxy_type*>(&get_key(*it));
 					auto pass_hist_val = static_cast<index_t>((key >> (bits_in_mask * pass)) & mask);
@@ -158,7 +185,7 @@ namespace allradixsort
 				}
 			}
 			else {
-				for (auto it = buffer.begin(); it != buffer.end(); ++it)
+				for (auto it = buffer.begin(); it != buffer_end; ++it)
 				{
 					auto key = *reinterpret_cast<typename traits<KeyType>::proxy_type*>(&get_key(*it));
 
@@ -173,6 +200,18 @@ namespace allradixsort
 		}
 	}
 
+	// Sorts [begin, end) using radix sort with the given key extraction function.
+	template<class KeyType, class Iter, class GetKeyFn>
+	void float_sort(Iter begin, Iter end, GetKeyFn get_key)
+	{
+		with_index_type(end - begin, [&](auto index)
+		{
+			basic_hists_vector<decltype(index)> hist;
+			std::vector<cont_type_t<Iter>> buffer;
+			float_sort<KeyType, Iter, GetKeyFn>(begin, end, get_key, hist, buffer);
+		});
+	}
+
 	// Sorts [begin, end) using radix sort 
 	template<class Iter>
 	void float_sort(Iter begin, Iter end)
@@ -31,21 +31,23 @@
 
 namespace allradixsort
 {
-	// Sorts [begin, end) using insertion sort with the given key extraction function.
-	template<class KeyType, class Iter, class GetKeyFn>
-	void integer_sort(Iter begin, Iter end, GetKeyFn get_key)
+	// Creating histograms, count each occurrence of indexed-byte value.
+	// In particular, histograms don't change when you change the order, 
+	// so I just do all the histogramming in one pass through the data. One read builds several histograms.
+	template<class KeyType, class Iter, class GetKeyFn, class IndexType>
+	void integer_histograms(Iter begin, Iter end, GetKeyFn get_key, basic_hists_vector<IndexType>& hist)
 	{
 		constexpr size_t num_passes = traits<KeyType>::num_passes;
 		constexpr size_t bits_in_mask = traits<KeyType>::bits_in_mask;
 		constexpr size_t mask = traits<KeyType>::mask;
 		constexpr size_t num_bins = traits<KeyType>::num_bins;
-		size_t size = end - begin;
 
-		using hists_vector = std::vector<std::vector<index_t>>;
-		// Creating histograms, count each occurrence of indexed-byte value.
-		// In particular, histograms don't change when you change the order, 
-		// so I just do all the histogramming in one pass through the data. One read builds several histograms.
-		hists_vector hist{ num_passes, std::vector<index_t>(num_bins) };
+		// reuse the memory of the given histograms
+		hist.resize(num_passes);
+		for (auto& pass_hist : hist)
+		{
+			pass_hist.assign(num_bins, 0);
+		}
 
 		for (Iter it = begin; it != end; ++it)
 		{
@@ -56,15 +58,23 @@ namespace allradixsort
 				++hist[pass][pass_hist_val];
 			}
 		}
+	}
+
+	// accumulate histograms.
+	// generate positional offsets. adjust starting point if signed.
+	template<class KeyType, class IndexType>
+	void integer_offsets(basic_hists_vector<IndexType>& hist)
+	{
+		constexpr size_t num_passes = traits<KeyType>::num_passes;
+		constexpr size_t bits_in_mask = traits<KeyType>::bits_in_mask;
+		constexpr size_t num_bins = traits<KeyType>::num_bins;
 
-		// accumulate histograms.
-		// generate positional offsets. adjust starting point if signed.
 		for (size_t pass = 0; pass < num_passes; ++pass)
 		{
 			bool is_signed_and_last_pass = traits<KeyType>::is_signed_integer
 				&& pass == (num_passes - 1);
 
-			index_t tsum, sum = 0;
+			IndexType tsum, sum = 0;
 			if (is_signed_and_last_pass) {
 				size_t cur_num_bins = (0x1u << (traits<KeyType>::num_bits - (num_passes - 1) * bits_in_mask));
 				size_t start = cur_num_bins / 2;
@@ -84,12 +94,29 @@ namespace allradixsort
 				}
 			}
 		}
+	}
+
+	// Sorts [begin, end) using insertion sort with the given key extraction function.
+	// hist and buffer are scratch memory, which can be reused between calls.
+	template<class KeyType, class Iter, class GetKeyFn, class IndexType>
+	void integer_sort(Iter begin, Iter end, GetKeyFn get_key, basic_hists_vector<IndexType>& hist, std::vector<cont_type_t<Iter>>& buffer)
+	{
+		constexpr size_t num_passes = traits<KeyType>::num_passes;
+		constexpr size_t bits_in_mask = traits<KeyType>::bits_in_mask;
+		constexpr size_t mask = traits<KeyType>::mask;
+		size_t size = end - begin;
+
+		integer_histograms<KeyType>(begin, end, get_key, hist);
+		integer_offsets<KeyType>(hist);
 
 		// distribute.
 		// stable reordering of elements. backward to avoid shifting
 		// the counter array.
 		// temp buffer to hold values in odd passes
-		std::vector<cont_type_t<Iter>> buffer(size);
+		if (buffer.size() < size) {
+			buffer.resize(size);
+		}
+		auto buffer_end = buffer.begin() + size;
 
 		for (size_t pass = 0; pass < num_passes;)
 		{
@@ -105,14 +132,14 @@ namespace allradixsort
 			++pass;
 			if (pass == num_passes) {
 				// if num_passes is odd, copy values back to input container on last pass
-				for (auto src_it = buffer.begin(), dst_it = begin; src_it != buffer.end(); ++src_it)
+				for (auto src_it = buffer.begin(), dst_it = begin; src_it != buffer_end; ++src_it)
 				{
 					*(dst_it++) = std::move(*src_it);
 				}
 			}
 			else {
 				// use input container as a buffer
-				for (auto it = buffer.begin(); it != buffer.end(); ++it)
+				for (auto it = buffer.begin(); it != buffer_end; ++it)
 				{
 
 					auto key = get_key(*it);
@@ -126,5 +153,17 @@ namespace allradixsort
 			++pass;
 		}
 	}
+
+	// Sorts [begin, end) using radix sort with the given key extraction function.
+	template<class KeyType, class Iter, class GetKeyFn>
+	void integer_sort(Iter begin, Iter end, GetKeyFn get_key)
+	{
+		with_index_type(end - begin, [&](auto index)
+		{
+			basic_hists_vector<decltype(index)> hist;
+			std::vector<cont_type_t<Iter>> buffer;
+			integer_sort<KeyType, Iter, GetKeyFn>(begin, end, get_key, hist, buffer);
+		});
+	}
 }
 
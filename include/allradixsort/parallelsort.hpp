@@ -0,0 +1,250 @@
+#pragma once
+/*
+ * Copyright (c) 2020 Vyacheslav Bloshchanevich
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include <vector>
+#include <algorithm>
+#include <type_traits>
+#include <memory>
+#include <cstring>
+
+#include "traits.hpp"
+#include "threadpool.hpp"
+#include "integersort.hpp"
+#include "floatsort.hpp"
+
+namespace allradixsort
+{
+	// Minimal number of elements per thread, smaller inputs are not worth the synchronization.
+	constexpr size_t parallel_min_chunk_size = 1 << 14;
+
+	// Number of chunks [begin, end) is split into, 1 means that the input should be sorted sequentially.
+	inline size_t parallel_num_chunks(size_t size, const thread_pool& pool)
+	{
+		return std::max<size_t>(1, std::min(pool.concurrency(), size / parallel_min_chunk_size));
+	}
+
+	// Temp buffer for the parallel passes. Every chunk is constructed in place by the thread working
+	// on it in the later passes, pool.run_static() keeps the chunk on that thread. So on NUMA systems
+	// the pages of a chunk are first touched and placed on the memory node of its thread,
+	// instead of all of them on the node of the calling thread.
+	template<class T>
+	class parallel_buffer
+	{
+	public:
+		template<class ChunkBeginFn>
+		parallel_buffer(size_t size, size_t num_chunks, ChunkBeginFn chunk_begin, thread_pool& pool)
+			: size_(size), data_(std::allocator<T>().allocate(size))
+		{
+			std::vector<char> constructed(num_chunks, false);
+			try {
+				pool.run_static(num_chunks, [&](size_t chunk)
+				{
+					std::uninitialized_value_construct(data_ + chunk_begin(chunk), data_ + chunk_begin(chunk + 1));
+					constructed[chunk] = true;
+				});
+			}
+			catch (...) {
+				for (size_t chunk = 0; chunk < num_chunks; ++chunk)
+				{
+					if (constructed[chunk]) {
+						std::destroy(data_ + chunk_begin(chunk), data_ + chunk_begin(chunk + 1));
+					}
+				}
+				std::allocator<T>().deallocate(data_, size_);
+				throw;
+			}
+		}
+
+		~parallel_buffer()
+		{
+			std::destroy(data_, data_ + size_);
+			std::allocator<T>().deallocate(data_, size_);
+		}
+
+		parallel_buffer(const parallel_buffer&) = delete;
+		parallel_buffer& operator=(const parallel_buffer&) = delete;
+
+		T* get() { return data_; }
+
+	private:
+		size_t size_;
+		T* data_;
+	};
+
+	// Radix sort passes over [begin, end) split into num_chunks chunks, one thread per chunk.
+	// Each pass builds per chunk histograms of the pass digit, turns them into per chunk offsets
+	// and scatters every chunk into its own disjoint slots of the destination, so the result
+	// is stable and identical to the sequential sort.
+	// get_digit(element, pass) should return the bin of the element in the given pass.
+	// IndexType should be able to address all elements of [begin, end).
+	template<class KeyType, class IndexType, class Iter, class GetDigitFn>
+	void parallel_radix_passes(Iter begin, Iter end, GetDigitFn get_digit, size_t num_chunks, thread_pool& pool)
+	{
+		constexpr size_t num_passes = traits<KeyType>::num_passes;
+		constexpr size_t num_bins = traits<KeyType>::num_bins;
+		size_t size = end - begin;
+
+		auto chunk_begin = [size, num_chunks](size_t chunk) { return size * chunk / num_chunks; };
+
+		// histograms are allocated by the threads working on the chunks, see thread_pool::run_static()
+		basic_hists_vector<IndexType> hist(num_chunks);
+		// temp buffer to hold values in odd passes
+		parallel_buffer<cont_type_t<Iter>> buffer(size, num_chunks, chunk_begin, pool);
+
+		auto do_pass = [&](auto src, auto dst, size_t pass)
+		{
+			// histogram of every chunk
+			pool.run_static(num_chunks, [&](size_t chunk)
+			{
+				auto& chunk_hist = hist[chunk];
+				chunk_hist.assign(num_bins, 0);
+				for (auto it = src + chunk_begin(chunk), last = src + chunk_begin(chunk + 1); it != last; ++it)
+				{
+					++chunk_hist[get_digit(*it, pass)];
+				}
+			});
+
+			// generate positional offsets, a bin of a chunk follows the same bin of previous chunks.
+			IndexType tsum, sum = 0;
+			for (size_t i = 0; i < num_bins; ++i)
+			{
+				for (size_t chunk = 0; chunk < num_chunks; ++chunk)
+				{
+					tsum = hist[chunk][i] + sum;
+					hist[chunk][i] = sum;
+					sum = tsum;
+				}
+			}
+
+			// distribute, stable reordering of elements of every chunk.
+			pool.run_static(num_chunks, [&](size_t chunk)
+			{
+				auto& chunk_hist = hist[chunk];
+				for (auto it = src + chunk_begin(chunk), last = src + chunk_begin(chunk + 1); it != last; ++it)
+				{
+					auto index = chunk_hist[get_digit(*it, pass)]++;
+					*(dst + index) = std::move(*it);
+				}
+			});
+		};
+
+		for (size_t pass = 0; pass < num_passes; ++pass)
+		{
+			if (pass % 2 == 0) {
+				do_pass(begin, buffer.get(), pass);
+			}
+			else {
+				do_pass(buffer.get(), begin, pass);
+			}
+		}
+
+		if (num_passes % 2 != 0) {
+			// if num_passes is odd, move values back to input container
+			pool.run_static(num_chunks, [&](size_t chunk)
+			{
+				std::move(buffer.get() + chunk_begin(chunk), buffer.get() + chunk_begin(chunk + 1), begin + chunk_begin(chunk));
+			});
+		}
+	}
+
+	// Sorts [begin, end) using radix sort on the threads of the pool.
+	template<class KeyType, class Iter, class GetKeyFn>
+	void parallel_integer_sort(Iter begin, Iter end, GetKeyFn get_key, thread_pool& pool)
+	{
+		size_t num_chunks = parallel_num_chunks(end - begin, pool);
+		if (num_chunks < 2) {
+			integer_sort<KeyType, Iter, GetKeyFn>(begin, end, get_key);
+			return;
+		}
+
+		auto get_digit = [&get_key](auto& el, size_t pass) -> size_t
+		{
+			constexpr size_t num_passes = traits<KeyType>::num_passes;
+			constexpr size_t bits_in_mask = traits<KeyType>::bits_in_mask;
+			constexpr size_t mask = traits<KeyType>::mask;
+			// by signed integers the last pass starts from the bin of the most negative value,
+			// flipping the highest bit of the digit gives the same order.
+			constexpr size_t last_pass_flip = traits<KeyType>::is_signed_integer ?
+				(0x1u << (traits<KeyType>::num_bits - (num_passes - 1) * bits_in_mask)) / 2
+				: 0;
+
+			auto key = get_key(el);
+			size_t pass_hist_val = static_cast<size_t>((key >> (bits_in_mask * pass)) & mask);
+			return pass == num_passes - 1 ? pass_hist_val ^ last_pass_flip : pass_hist_val;
+		};
+		with_index_type(end - begin, [&](auto index)
+		{
+			parallel_radix_passes<KeyType, decltype(index)>(begin, end, get_digit, num_chunks, pool);
+		});
+	}
+
+	// Sorts [begin, end) using radix sort on the threads of the pool.
+	template<class KeyType, class Iter, class GetKeyFn>
+	void parallel_float_sort(Iter begin, Iter end, GetKeyFn get_key, thread_pool& pool)
+	{
+		using proxy_type = typename traits<KeyType>::proxy_type;
+		size_t size = end - begin;
+
+		size_t num_chunks = parallel_num_chunks(size, pool);
+		if (num_chunks < 2) {
+			float_sort<KeyType, Iter, GetKeyFn>(begin, end, get_key);
+			return;
+		}
+
+		auto chunk_begin = [size, num_chunks](size_t chunk) { return size * chunk / num_chunks; };
+
+		// save flipped keys, so that they are sorted as unsigned integers
+		pool.run_static(num_chunks, [&](size_t chunk)
+		{
+			for (auto it = begin + chunk_begin(chunk), last = begin + chunk_begin(chunk + 1); it != last; ++it)
+			{
+				auto key = float_flip<KeyType, proxy_type>(get_key(*it));
+				std::memcpy(&get_key(*it), &key, sizeof(KeyType));
+			}
+		});
+
+		auto get_digit = [&get_key](auto& el, size_t pass) -> size_t
+		{
+			constexpr size_t bits_in_mask = traits<KeyType>::bits_in_mask;
+			constexpr size_t mask = traits<KeyType>::mask;
+
+			proxy_type key;
+			std::memcpy(&key, &get_key(el), sizeof(key));
+			return static_cast<size_t>((key >> (bits_in_mask * pass)) & mask);
+		};
+		with_index_type(size, [&](auto index)
+		{
+			parallel_radix_passes<KeyType, decltype(index)>(begin, end, get_digit, num_chunks, pool);
+		});
+
+		// restore flipped keys
+		pool.run_static(num_chunks, [&](size_t chunk)
+		{
+			for (auto it = begin + chunk_begin(chunk), last = begin + chunk_begin(chunk + 1); it != last; ++it)
+			{
+				auto restored_key = float_flip_inv<KeyType, proxy_type>(get_key(*it));
+				std::memcpy(&get_key(*it), &restored_key, sizeof(KeyType));
+			}
+		});
+	}
+}
@@ -25,10 +25,23 @@
 #include <array>
 #include <functional>
 #include <type_traits>
+#if __has_include(<version>)
+#include <version>
+#endif
+
+// The execution policy overloads of sort are available if the standard library implements <execution>.
+// Define ALLRADIXSORT_NO_EXECUTION_POLICY to leave them out and to not include <execution>.
+#if defined(__cpp_lib_execution) && !defined(ALLRADIXSORT_NO_EXECUTION_POLICY)
+#include <execution>
+#define ALLRADIXSORT_EXECUTION_POLICY
+#endif
 
 #include "traits.hpp"
 #include "integersort.hpp"
 #include "floatsort.hpp"
+#include "parallelsort.hpp"
+#include "sortbykey.hpp"
+#include "segmentsort.hpp"
 
 namespace allradixsort
 {
@@ -56,5 +69,83 @@ namespace allradixsort
 	{
 		sort<cont_type_t<Iter>, Iter>(begin, end, [](cont_type_t<Iter>& el) ->cont_type_t<Iter>&{ return el; });
 	}
-}
 
+	// Sorts keys [kbegin, kend) using radix sort and reorders the values starting at vbegin
+	// the same way, so that a value stays paired with its key. The sort is stable.
+	template<class KeyIter, class ValueIter>
+	void sort_by_key(KeyIter kbegin, KeyIter kend, ValueIter vbegin)
+	{
+		using KeyType = cont_type_t<KeyIter>;
+		if constexpr (traits<KeyType>::is_integer) {
+			integer_sort_by_key(kbegin, kend, vbegin);
+		}
+		else if constexpr (traits<KeyType>::is_float) {
+			float_sort_by_key(kbegin, kend, vbegin);
+		}
+		else {
+			static_assert(dependent_false_v<KeyType>, "this key type is not supported");
+		}
+	}
+
+	// Sorts independent segments of a container in one call, the segment i is
+	// [begin + offsets[i], begin + offsets[i + 1]), so [offsets_begin, offsets_end) holds
+	// one offset more than there are segments. Segments are sorted in parallel on the shared thread pool.
+	template<class KeyType, class Iter, class OffsetIter, class GetKeyFn>
+	void segmented_sort(Iter begin, OffsetIter offsets_begin, OffsetIter offsets_end, GetKeyFn get_key)
+	{
+		if constexpr (traits<KeyType>::is_integer || traits<KeyType>::is_float) {
+			segmented_radix_sort<KeyType>(begin, offsets_begin, offsets_end, get_key, thread_pool::instance());
+		}
+		else {
+			static_assert(dependent_false_v<KeyType>, "this key type is not supported");
+		}
+	}
+
+	// Sorts independent segments of a container of primitive values in one call
+	template<class Iter, class OffsetIter>
+	void segmented_sort(Iter begin, OffsetIter offsets_begin, OffsetIter offsets_end)
+	{
+		segmented_sort<cont_type_t<Iter>>(begin, offsets_begin, offsets_end,
+			[](cont_type_t<Iter>& el) ->cont_type_t<Iter>&{ return el; });
+	}
+
+#ifdef ALLRADIXSORT_EXECUTION_POLICY
+	template<class ExecutionPolicy>
+	inline constexpr bool is_parallel_policy_v =
+		std::is_same_v<std::decay_t<ExecutionPolicy>, std::execution::parallel_policy>
+		|| std::is_same_v<std::decay_t<ExecutionPolicy>, std::execution::parallel_unsequenced_policy>;
+
+	template<class ExecutionPolicy>
+	using enable_if_execution_policy_t = std::enable_if_t<std::is_execution_policy_v<std::decay_t<ExecutionPolicy>>>;
+
+	// Sorts [begin, end) using radix sort with the given key extraction function.
+	// std::execution::par and std::execution::par_unseq sort on the shared thread pool,
+	// other policies sort sequentially. The result is the same for all policies.
+	template<class KeyType, class ExecutionPolicy, class Iter, class GetKeyFn,
+		class = enable_if_execution_policy_t<ExecutionPolicy>>
+	void sort(ExecutionPolicy&&, Iter begin, Iter end, GetKeyFn get_key)
+	{
+		if constexpr (!is_parallel_policy_v<ExecutionPolicy>) {
+			sort<KeyType, Iter, GetKeyFn>(begin, end, get_key);
+		}
+		else if constexpr (traits<KeyType>::is_integer) {
+			parallel_integer_sort<KeyType, Iter, GetKeyFn>(begin, end, get_key, thread_pool::instance());
+		}
+		else if constexpr (traits<KeyType>::is_float) {
+			parallel_float_sort<KeyType, Iter, GetKeyFn>(begin, end, get_key, thread_pool::instance());
+		}
+		else {
+			static_assert(dependent_false_v<KeyType>, "this key type is not supported");
+		}
+	}
+
+	// Sorts [begin, end) using radix sort with the given execution policy
+	template<class ExecutionPolicy, class Iter,
+		class = enable_if_execution_policy_t<ExecutionPolicy>>
+	void sort(ExecutionPolicy&& policy, Iter begin, Iter end)
+	{
+		sort<cont_type_t<Iter>>(std::forward<ExecutionPolicy>(policy), begin, end,
+			[](cont_type_t<Iter>& el) ->cont_type_t<Iter>&{ return el; });
+	}
+#endif
+}
@@ -0,0 +1,182 @@
+#pragma once
+/*
+ * Copyright (c) 2020 Vyacheslav Bloshchanevich
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include <vector>
+#include <algorithm>
+#include <type_traits>
+
+#include "traits.hpp"
+#include "threadpool.hpp"
+#include "integersort.hpp"
+#include "floatsort.hpp"
+#include "parallelsort.hpp"
+
+namespace allradixsort
+{
+	// Segments up to this size are sorted by insertion sort, clearing the histograms would cost more.
+	constexpr size_t small_segment_size = 64;
+
+	// Segments from this size on are sorted one by one, each of them by all threads of the pool.
+	// Smaller segments wouldn't give every thread a chunk, so they are sorted in the groups.
+	inline size_t large_segment_size(const thread_pool& pool)
+	{
+		return pool.concurrency() * parallel_min_chunk_size;
+	}
+
+	// Key of the element as an integer in radix sort order.
+	template<class KeyType, class T, class GetKeyFn>
+	auto radix_order_key(T& el, GetKeyFn& get_key)
+	{
+		if constexpr (traits<KeyType>::is_float) {
+			return float_flip<KeyType, typename traits<KeyType>::proxy_type>(get_key(el));
+		}
+		else {
+			return get_key(el);
+		}
+	}
+
+	// Sorts a small range [begin, end) using stable insertion sort in the same order as radix sort.
+	template<class KeyType, class Iter, class GetKeyFn>
+	void small_sort(Iter begin, Iter end, GetKeyFn& get_key)
+	{
+		if (end - begin < 2) {
+			return;
+		}
+		for (Iter it = begin + 1; it != end; ++it)
+		{
+			auto key = radix_order_key<KeyType>(*it, get_key);
+			if (!(key < radix_order_key<KeyType>(*(it - 1), get_key))) {
+				continue;
+			}
+			auto el = std::move(*it);
+			Iter hole = it;
+			do
+			{
+				*hole = std::move(*(hole - 1));
+				--hole;
+			} while (hole != begin && key < radix_order_key<KeyType>(*(hole - 1), get_key));
+			*hole = std::move(el);
+		}
+	}
+
+	// Splits the segments, which are sorted in groups, into groups of about the same number of elements.
+	// Returns the first segment of every group followed by the number of segments. Segments
+	// from large_size on are sorted afterwards by all threads, their elements don't count.
+	template<class OffsetIter>
+	std::vector<size_t> segment_groups(OffsetIter offsets_begin, OffsetIter offsets_end, size_t concurrency, size_t large_size)
+	{
+		size_t num_segments = offsets_end - offsets_begin - 1;
+		auto segment_size = [&](size_t segment)
+		{
+			return static_cast<size_t>(*(offsets_begin + segment + 1) - *(offsets_begin + segment));
+		};
+
+		size_t grouped_size = 0;
+		for (size_t segment = 0; segment < num_segments; ++segment)
+		{
+			size_t size = segment_size(segment);
+			if (size < large_size) {
+				grouped_size += size;
+			}
+		}
+
+		// several groups per thread to even out the work
+		size_t num_groups = std::max<size_t>(1, std::min(concurrency * 4, grouped_size / parallel_min_chunk_size));
+
+		std::vector<size_t> group_begin(num_groups + 1, num_segments);
+		group_begin[0] = 0;
+		size_t group = 1;
+		size_t sum = 0;
+		for (size_t segment = 0; segment < num_segments && group < num_groups; ++segment)
+		{
+			// a group starts when the elements before the segment reach its share
+			while (group < num_groups && sum >= grouped_size * group / num_groups)
+			{
+				group_begin[group++] = segment;
+			}
+			size_t size = segment_size(segment);
+			if (size < large_size) {
+				sum += size;
+			}
+		}
+		return group_begin;
+	}
+
+	// Sorts every segment [begin + offsets[i], begin + offsets[i + 1]) for offsets in [offsets_begin, offsets_end).
+	// Small and medium segments are split into groups of about the same number of elements, the groups
+	// are sorted in parallel, each group reusing one histogram and buffer for all its segments.
+	// Large segments are sorted afterwards by the parallel radix sort.
+	template<class KeyType, class Iter, class OffsetIter, class GetKeyFn>
+	void segmented_radix_sort(Iter begin, OffsetIter offsets_begin, OffsetIter offsets_end, GetKeyFn get_key, thread_pool& pool)
+	{
+		if (offsets_end - offsets_begin < 2) {
+			return;
+		}
+		size_t num_segments = offsets_end - offsets_begin - 1;
+		auto segment_begin = [&](size_t segment) { return begin + *(offsets_begin + segment); };
+		auto segment_size = [&](size_t segment)
+		{
+			return static_cast<size_t>(*(offsets_begin + segment + 1) - *(offsets_begin + segment));
+		};
+
+		size_t large_size = large_segment_size(pool);
+		std::vector<size_t> group_begin = segment_groups(offsets_begin, offsets_end, pool.concurrency(), large_size);
+		size_t num_groups = group_begin.size() - 1;
+
+		pool.run(num_groups, [&](size_t group)
+		{
+			hists_vector hist;
+			std::vector<cont_type_t<Iter>> buffer;
+			for (size_t segment = group_begin[group]; segment < group_begin[group + 1]; ++segment)
+			{
+				size_t size = segment_size(segment);
+				Iter first = segment_begin(segment);
+				if (size <= small_segment_size) {
+					small_sort<KeyType>(first, first + size, get_key);
+				}
+				else if (size < large_size) {
+					if constexpr (traits<KeyType>::is_float) {
+						float_sort<KeyType>(first, first + size, get_key, hist, buffer);
+					}
+					else {
+						integer_sort<KeyType>(first, first + size, get_key, hist, buffer);
+					}
+				}
+			}
+		});
+
+		for (size_t segment = 0; segment < num_segments; ++segment)
+		{
+			size_t size = segment_size(segment);
+			if (size >= large_size) {
+				Iter first = segment_begin(segment);
+				if constexpr (traits<KeyType>::is_float) {
+					parallel_float_sort<KeyType>(first, first + size, get_key, pool);
+				}
+				else {
+					parallel_integer_sort<KeyType>(first, first + size, get_key, pool);
+				}
+			}
+		}
+	}
+}
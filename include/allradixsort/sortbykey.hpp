@@ -0,0 +1,158 @@
+#pragma once
+/*
+ * Copyright (c) 2020 Vyacheslav Bloshchanevich
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include <vector>
+#include <algorithm>
+#include <type_traits>
+#include <cstring>
+
+#include "traits.hpp"
+#include "integersort.hpp"
+#include "floatsort.hpp"
+
+namespace allradixsort
+{
+	// Stable reordering of keys [kbegin, kend) and values starting at vbegin by radix passes.
+	// Keys and values are moved in lockstep, the values are never read to find their position.
+	// hist should hold positional offsets of every pass, key_to_proxy(key) should return
+	// the unsigned integer the digits are taken from.
+	// Passes, where all keys have the same digit, don't change the order and are skipped.
+	template<class KeyType, class KeyIter, class ValueIter, class KeyToProxyFn, class IndexType>
+	void distribute_by_key(KeyIter kbegin, KeyIter kend, ValueIter vbegin,
+		basic_hists_vector<IndexType>& hist, const std::vector<bool>& skip_pass, KeyToProxyFn key_to_proxy)
+	{
+		constexpr size_t num_passes = traits<KeyType>::num_passes;
+		constexpr size_t bits_in_mask = traits<KeyType>::bits_in_mask;
+		constexpr size_t mask = traits<KeyType>::mask;
+		size_t size = kend - kbegin;
+
+		// temp buffers to hold keys and values in odd passes
+		std::vector<cont_type_t<KeyIter>> key_buffer;
+		std::vector<cont_type_t<ValueIter>> value_buffer;
+		bool in_buffer = false;
+
+		auto do_pass = [&](auto ksrc, auto vsrc, auto kdst, auto vdst, size_t pass)
+		{
+			auto vit = vsrc;
+			for (auto kit = ksrc, klast = ksrc + size; kit != klast; ++kit, ++vit)
+			{
+				auto key = key_to_proxy(*kit);
+				auto pass_hist_val = static_cast<index_t>((key >> (bits_in_mask * pass)) & mask);
+
+				auto index = hist[pass][pass_hist_val]++;
+				*(kdst + index) = std::move(*kit);
+				*(vdst + index) = std::move(*vit);
+			}
+		};
+
+		for (size_t pass = 0; pass < num_passes; ++pass)
+		{
+			if (skip_pass[pass]) {
+				continue;
+			}
+			if (key_buffer.empty()) {
+				key_buffer.resize(size);
+				value_buffer.resize(size);
+			}
+			if (in_buffer) {
+				do_pass(key_buffer.begin(), value_buffer.begin(), kbegin, vbegin, pass);
+			}
+			else {
+				do_pass(kbegin, vbegin, key_buffer.begin(), value_buffer.begin(), pass);
+			}
+			in_buffer = !in_buffer;
+		}
+
+		if (in_buffer) {
+			// odd number of passes, move keys and values back to input containers
+			std::move(key_buffer.begin(), key_buffer.end(), kbegin);
+			std::move(value_buffer.begin(), value_buffer.end(), vbegin);
+		}
+	}
+
+	// A pass can be skipped if all keys fall into one bin, the histogram is checked before accumulating.
+	template<class IndexType>
+	std::vector<bool> trivial_passes(const basic_hists_vector<IndexType>& hist, size_t size)
+	{
+		std::vector<bool> skip_pass(hist.size());
+		for (size_t pass = 0; pass < hist.size(); ++pass)
+		{
+			skip_pass[pass] = std::find(hist[pass].begin(), hist[pass].end(), static_cast<IndexType>(size))
+				!= hist[pass].end();
+		}
+		return skip_pass;
+	}
+
+	// Sorts keys [kbegin, kend) using radix sort and reorders values starting at vbegin the same way.
+	template<class KeyIter, class ValueIter>
+	void integer_sort_by_key(KeyIter kbegin, KeyIter kend, ValueIter vbegin)
+	{
+		using KeyType = cont_type_t<KeyIter>;
+		using proxy_type = std::make_unsigned_t<KeyType>;
+		auto get_key = [](KeyType& key) -> KeyType& { return key; };
+
+		with_index_type(kend - kbegin, [&](auto index)
+		{
+			basic_hists_vector<decltype(index)> hist;
+			integer_histograms<KeyType>(kbegin, kend, get_key, hist);
+			std::vector<bool> skip_pass = trivial_passes(hist, kend - kbegin);
+			integer_offsets<KeyType>(hist);
+
+			distribute_by_key<KeyType>(kbegin, kend, vbegin, hist, skip_pass,
+				[](const KeyType& key) { return static_cast<proxy_type>(key); });
+		});
+	}
+
+	// Sorts keys [kbegin, kend) using radix sort and reorders values starting at vbegin the same way.
+	template<class KeyIter, class ValueIter>
+	void float_sort_by_key(KeyIter kbegin, KeyIter kend, ValueIter vbegin)
+	{
+		using KeyType = cont_type_t<KeyIter>;
+		using proxy_type = typename traits<KeyType>::proxy_type;
+		auto get_key = [](KeyType& key) -> KeyType& { return key; };
+
+		with_index_type(kend - kbegin, [&](auto index)
+		{
+			// keys are flipped in place while building histograms
+			basic_hists_vector<decltype(index)> hist;
+			float_histograms<KeyType>(kbegin, kend, get_key, hist);
+			std::vector<bool> skip_pass = trivial_passes(hist, kend - kbegin);
+			float_offsets<KeyType>(hist);
+
+			distribute_by_key<KeyType>(kbegin, kend, vbegin, hist, skip_pass,
+				[](KeyType& key)
+				{
+					proxy_type proxy;
+					std::memcpy(&proxy, &key, sizeof(proxy));
+					return proxy;
+				});
+		});
+
+		// restore flipped keys
+		for (KeyIter it = kbegin; it != kend; ++it)
+		{
+			auto restored_key = float_flip_inv<KeyType, proxy_type>(*it);
+			std::memcpy(&*it, &restored_key, sizeof(KeyType));
+		}
+	}
+}
@@ -0,0 +1,212 @@
+#pragma once
+/*
+ * Copyright (c) 2020 Vyacheslav Bloshchanevich
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <exception>
+#include <algorithm>
+
+namespace allradixsort
+{
+	// Fixed size pool of worker threads, reused by all parallel sorts.
+	// The calling thread takes part in the work, so a pool of N threads owns N - 1 workers.
+	// Nested or concurrent calls of run() don't wait for the pool, they execute the tasks inline.
+	class thread_pool
+	{
+	public:
+		explicit thread_pool(size_t num_threads = std::thread::hardware_concurrency())
+			: num_threads_(std::max<size_t>(1, num_threads))
+		{
+			for (size_t thread = 1; thread < num_threads_; ++thread)
+			{
+				workers_.emplace_back([this, thread] { worker_loop(thread); });
+			}
+		}
+
+		~thread_pool()
+		{
+			{
+				std::lock_guard<std::mutex> lock(mutex_);
+				stop_ = true;
+			}
+			start_cv_.notify_all();
+			for (auto& worker : workers_)
+			{
+				worker.join();
+			}
+		}
+
+		thread_pool(const thread_pool&) = delete;
+		thread_pool& operator=(const thread_pool&) = delete;
+
+		// number of threads working on a run() call, including the calling thread
+		size_t concurrency() const { return num_threads_; }
+
+		// Calls fn(task) for each task in [0, num_tasks) and blocks until all of them are done.
+		// The tasks are taken by the threads as they become free.
+		// The first exception thrown by a task is rethrown to the caller.
+		template<class Fn>
+		void run(size_t num_tasks, Fn&& fn)
+		{
+			run_tasks(num_tasks, fn, false);
+		}
+
+		// Like run(), but the task i is always executed by the thread i % concurrency(),
+		// the calling thread being the thread 0. So with the same calling thread, repeated calls
+		// execute a task on the same thread, and the memory a task touches first is placed
+		// on the NUMA node of that thread, as long as the scheduler keeps the thread on its node.
+		template<class Fn>
+		void run_static(size_t num_tasks, Fn&& fn)
+		{
+			run_tasks(num_tasks, fn, true);
+		}
+
+		// pool shared by the parallel sort overloads, sized to the number of hardware threads
+		static thread_pool& instance()
+		{
+			static thread_pool pool;
+			return pool;
+		}
+
+	private:
+		template<class Fn>
+		void run_tasks(size_t num_tasks, Fn& fn, bool is_static)
+		{
+			bool& inside = inside_pool();
+			if (inside || workers_.empty() || num_tasks < 2 || !submit_mutex_.try_lock()) {
+				for (size_t task = 0; task < num_tasks; ++task)
+				{
+					fn(task);
+				}
+				return;
+			}
+			std::lock_guard<std::mutex> submit_lock(submit_mutex_, std::adopt_lock);
+
+			{
+				std::lock_guard<std::mutex> lock(mutex_);
+				task_ = std::ref(fn);
+				num_tasks_ = num_tasks;
+				is_static_ = is_static;
+				next_task_ = 0;
+				active_ = workers_.size();
+				error_ = nullptr;
+				++generation_;
+			}
+			start_cv_.notify_all();
+
+			inside = true;
+			execute_tasks(0);
+			inside = false;
+
+			std::exception_ptr error;
+			{
+				std::unique_lock<std::mutex> lock(mutex_);
+				done_cv_.wait(lock, [this] { return active_ == 0; });
+				task_ = nullptr;
+				std::swap(error, error_);
+			}
+			if (error) {
+				std::rethrow_exception(error);
+			}
+		}
+
+		// true on the pool workers and on a thread executing tasks inside run()
+		static bool& inside_pool()
+		{
+			thread_local bool inside = false;
+			return inside;
+		}
+
+		void worker_loop(size_t thread)
+		{
+			inside_pool() = true;
+			size_t seen_generation = 0;
+			for (;;)
+			{
+				{
+					std::unique_lock<std::mutex> lock(mutex_);
+					start_cv_.wait(lock, [&] { return stop_ || generation_ != seen_generation; });
+					if (stop_) {
+						return;
+					}
+					seen_generation = generation_;
+				}
+
+				execute_tasks(thread);
+
+				std::lock_guard<std::mutex> lock(mutex_);
+				if (--active_ == 0) {
+					done_cv_.notify_one();
+				}
+			}
+		}
+
+		void execute_tasks(size_t thread)
+		{
+			if (is_static_) {
+				for (size_t task = thread; task < num_tasks_; task += num_threads_)
+				{
+					execute_task(task);
+				}
+			}
+			else {
+				for (size_t task = next_task_++; task < num_tasks_; task = next_task_++)
+				{
+					execute_task(task);
+				}
+			}
+		}
+
+		void execute_task(size_t task)
+		{
+			try {
+				task_(task);
+			}
+			catch (...) {
+				std::lock_guard<std::mutex> lock(mutex_);
+				if (!error_) {
+					error_ = std::current_exception();
+				}
+			}
+		}
+
+		const size_t num_threads_;
+		std::vector<std::thread> workers_;
+		std::mutex submit_mutex_;
+		std::mutex mutex_;
+		std::condition_variable start_cv_;
+		std::condition_variable done_cv_;
+		std::function<void(size_t)> task_;
+		size_t num_tasks_ = 0;
+		bool is_static_ = false;
+		std::atomic<size_t> next_task_{ 0 };
+		size_t active_ = 0;
+		size_t generation_ = 0;
+		bool stop_ = false;
+		std::exception_ptr error_;
+	};
+}
@@ -21,11 +21,35 @@
  * IN THE SOFTWARE.
  */
 
+#include <cstdint>
+#include <cstddef>
 #include <limits>
+#include <vector>
 
 namespace allradixsort
 {
+	// histogram counter, 32 bits keep the histograms of a pass in L1 cache
 	using index_t = uint32_t;
+	// histogram counter for containers with more than 4G elements
+	using large_index_t = uint64_t;
+
+	// set of histograms of IndexType counters
+	template<class IndexType>
+	using basic_hists_vector = std::vector<std::vector<IndexType>>;
+	using hists_vector = basic_hists_vector<index_t>;
+
+	// Calls fn(IndexType{}) with the smallest counter type able to address size elements.
+	// The check is done once per sort, so small containers keep 32 bit counters.
+	template<class Fn>
+	void with_index_type(size_t size, Fn fn)
+	{
+		if (size <= std::numeric_limits<index_t>::max()) {
+			fn(index_t{});
+		}
+		else {
+			fn(large_index_t{});
+		}
+	}
 
 	template <typename It>
 	using cont_type_t = typename std::iterator_traits<It>::value_type;
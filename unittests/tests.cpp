@@ -4,6 +4,9 @@
 #include <random>
 #include <limits>
 #include <iomanip>
+#include <cstring>
+#include <string>
+#include <thread>
 
 #include "allradixsort/radixsort.hpp"
 
@@ -17,6 +20,8 @@ namespace tests
 	using Array = std::vector<std::pair<KeyType, size_t>>;
 
 	constexpr size_t N = 10000;
+	// big enough to be split between several threads
+	constexpr size_t PAR_N = 200000;
 
 	template<class KeyType>
 	void prepare_data(Array<KeyType>& arr, KeyType min, KeyType max)
@@ -158,4 +163,482 @@ namespace tests
 		using KeyType = double;
 		TypeTest<KeyType>(-1000.0, 1000.0);
 	}
+
+	template<class KeyType>
+	void check_equal(Array<KeyType>& InArr, Array<KeyType>& Expected)
+	{
+		ASSERT_EQ(InArr.size(), Expected.size());
+		for (size_t i = 0; i < InArr.size(); ++i)
+		{
+			ASSERT_TRUE(std::memcmp(&InArr[i].first, &Expected[i].first, sizeof(KeyType)) == 0
+				&& InArr[i].second == Expected[i].second);
+		}
+	}
+
+	template<typename KeyType>
+	void ParallelTypeTest(KeyType min, KeyType max)
+	{
+		auto get_key = [](auto& el) -> KeyType& { return el.first; };
+
+		Array<KeyType> data(PAR_N);
+		prepare_data<KeyType>(data, min, max);
+		Array<KeyType> expected(data);
+		sort<KeyType>(expected.begin(), expected.end(), get_key);
+
+#ifdef ALLRADIXSORT_EXECUTION_POLICY
+		Array<KeyType> seq_data(data);
+		sort<KeyType>(std::execution::seq, seq_data.begin(), seq_data.end(), get_key);
+		check_equal(seq_data, expected);
+
+		Array<KeyType> par_data(data);
+		sort<KeyType>(std::execution::par, par_data.begin(), par_data.end(), get_key);
+		check_equal(par_data, expected);
+
+		Array<KeyType> par_unseq_data(data);
+		sort<KeyType>(std::execution::par_unseq, par_unseq_data.begin(), par_unseq_data.end(), get_key);
+		check_equal(par_unseq_data, expected);
+#endif
+
+		// force several threads regardless of the hardware
+		thread_pool pool(4);
+		Array<KeyType> pool_data(data);
+		if constexpr (traits<KeyType>::is_float) {
+			parallel_float_sort<KeyType>(pool_data.begin(), pool_data.end(), get_key, pool);
+		}
+		else {
+			parallel_integer_sort<KeyType>(pool_data.begin(), pool_data.end(), get_key, pool);
+		}
+		check_equal(pool_data, expected);
+	}
+
+	TEST(ParallelRadixSort, uint8_t_test)
+	{
+		using KeyType = uint8_t;
+		ParallelTypeTest<KeyType>(std::numeric_limits<KeyType>::min(), std::numeric_limits<KeyType>::max());
+	}
+
+	TEST(ParallelRadixSort, uint16_t_test)
+	{
+		using KeyType = uint16_t;
+		ParallelTypeTest<KeyType>(std::numeric_limits<KeyType>::min(), std::numeric_limits<KeyType>::max());
+	}
+
+	TEST(ParallelRadixSort, uint32_t_test)
+	{
+		using KeyType = uint32_t;
+		ParallelTypeTest<KeyType>(std::numeric_limits<KeyType>::min(), std::numeric_limits<KeyType>::max());
+	}
+
+	TEST(ParallelRadixSort, uint64_t_test)
+	{
+		using KeyType = uint64_t;
+		ParallelTypeTest<KeyType>(std::numeric_limits<KeyType>::min(), std::numeric_limits<KeyType>::max()/2);
+	}
+
+	TEST(ParallelRadixSort, int8_t_test)
+	{
+		using KeyType = int8_t;
+		ParallelTypeTest<KeyType>(std::numeric_limits<KeyType>::min(), std::numeric_limits<KeyType>::max());
+	}
+
+	TEST(ParallelRadixSort, int16_t_test)
+	{
+		using KeyType = int16_t;
+		ParallelTypeTest<KeyType>(std::numeric_limits<KeyType>::min(), std::numeric_limits<KeyType>::max());
+	}
+
+	TEST(ParallelRadixSort, int32_t_test)
+	{
+		using KeyType = int32_t;
+		ParallelTypeTest<KeyType>(std::numeric_limits<KeyType>::min(), std::numeric_limits<KeyType>::max());
+	}
+
+	TEST(ParallelRadixSort, int64_t_test)
+	{
+		using KeyType = int64_t;
+		ParallelTypeTest<KeyType>(std::numeric_limits<KeyType>::min()/2, std::numeric_limits<KeyType>::max()/2);
+	}
+
+	TEST(ParallelRadixSort, float_test)
+	{
+		using KeyType = float;
+		ParallelTypeTest<KeyType>(-1000.0, 1000.0);
+	}
+
+	TEST(ParallelRadixSort, double_test)
+	{
+		using KeyType = double;
+		ParallelTypeTest<KeyType>(-1000.0, 1000.0);
+	}
+
+	template<typename KeyType>
+	void ParallelPrimitiveTest(KeyType min, KeyType max)
+	{
+		Array<KeyType> pairs(PAR_N);
+		prepare_data<KeyType>(pairs, min, max);
+		std::vector<KeyType> data(PAR_N);
+		for (size_t i = 0; i < PAR_N; ++i)
+		{
+			data[i] = pairs[i].first;
+		}
+		std::vector<KeyType> expected(data);
+		allradixsort::sort(expected.begin(), expected.end());
+
+		// trivial element type, the buffer is constructed by the threads of the chunks
+		thread_pool pool(4);
+		auto get_key = [](KeyType& el) -> KeyType& { return el; };
+		if constexpr (traits<KeyType>::is_float) {
+			parallel_float_sort<KeyType>(data.begin(), data.end(), get_key, pool);
+		}
+		else {
+			parallel_integer_sort<KeyType>(data.begin(), data.end(), get_key, pool);
+		}
+		ASSERT_TRUE(std::memcmp(data.data(), expected.data(), PAR_N * sizeof(KeyType)) == 0);
+	}
+
+	TEST(ParallelRadixSort, uint32_t_primitive_test)
+	{
+		using KeyType = uint32_t;
+		ParallelPrimitiveTest<KeyType>(std::numeric_limits<KeyType>::min(), std::numeric_limits<KeyType>::max());
+	}
+
+	TEST(ParallelRadixSort, int16_t_primitive_test)
+	{
+		using KeyType = int16_t;
+		ParallelPrimitiveTest<KeyType>(std::numeric_limits<KeyType>::min(), std::numeric_limits<KeyType>::max());
+	}
+
+	TEST(ParallelRadixSort, double_primitive_test)
+	{
+		using KeyType = double;
+		ParallelPrimitiveTest<KeyType>(-1000.0, 1000.0);
+	}
+
+	TEST(ThreadPool, run_static_test)
+	{
+		thread_pool pool(4);
+		std::vector<std::thread::id> first(8), second(8);
+
+		pool.run_static(first.size(), [&](size_t task) { first[task] = std::this_thread::get_id(); });
+		pool.run_static(second.size(), [&](size_t task) { second[task] = std::this_thread::get_id(); });
+		// the same task runs on the same thread, the task 0 on the calling thread
+		ASSERT_TRUE(first == second);
+		ASSERT_EQ(first[0], std::this_thread::get_id());
+		for (size_t task = 0; task < first.size(); ++task)
+		{
+			ASSERT_EQ(first[task], first[task % pool.concurrency()]);
+			if (task > 0 && task < pool.concurrency()) {
+				ASSERT_NE(first[task], first[0]);
+			}
+		}
+	}
+
+#ifdef ALLRADIXSORT_EXECUTION_POLICY
+	TEST(ParallelRadixSort, primitive_test)
+	{
+		std::vector<int32_t> data(PAR_N);
+		std::default_random_engine eng(42);
+		std::uniform_int_distribution<int32_t> distr;
+		for (auto& el : data) el = distr(eng);
+		std::vector<int32_t> expected(data);
+		std::sort(expected.begin(), expected.end());
+
+		allradixsort::sort(std::execution::par_unseq, data.begin(), data.end());
+		ASSERT_TRUE(data == expected);
+	}
+#endif
+
+	template<typename KeyType>
+	void SortByKeyTest(KeyType min, KeyType max)
+	{
+		Array<KeyType> data(N);
+		prepare_data<KeyType>(data, min, max);
+		std::vector<KeyType> keys(N);
+		std::vector<size_t> values(N);
+		for (size_t i = 0; i < N; ++i)
+		{
+			keys[i] = data[i].first;
+			values[i] = data[i].second;
+		}
+
+		sort<KeyType>(data.begin(), data.end(), [](auto& el) -> KeyType& { return el.first; });
+		sort_by_key(keys.begin(), keys.end(), values.begin());
+		// check that keys and values are sorted the same way as pairs
+		for (size_t i = 0; i < N; ++i)
+		{
+			ASSERT_TRUE(keys[i] == data[i].first && values[i] == data[i].second);
+		}
+	}
+
+	TEST(SortByKey, uint8_t_test)
+	{
+		using KeyType = uint8_t;
+		SortByKeyTest<KeyType>(std::numeric_limits<KeyType>::min(), std::numeric_limits<KeyType>::max());
+	}
+
+	TEST(SortByKey, uint16_t_test)
+	{
+		using KeyType = uint16_t;
+		SortByKeyTest<KeyType>(std::numeric_limits<KeyType>::min(), std::numeric_limits<KeyType>::max());
+	}
+
+	TEST(SortByKey, uint32_t_test)
+	{
+		using KeyType = uint32_t;
+		SortByKeyTest<KeyType>(std::numeric_limits<KeyType>::min(), std::numeric_limits<KeyType>::max());
+	}
+
+	TEST(SortByKey, uint64_t_test)
+	{
+		using KeyType = uint64_t;
+		SortByKeyTest<KeyType>(std::numeric_limits<KeyType>::min(), std::numeric_limits<KeyType>::max()/2);
+	}
+
+	TEST(SortByKey, int8_t_test)
+	{
+		using KeyType = int8_t;
+		SortByKeyTest<KeyType>(std::numeric_limits<KeyType>::min(), std::numeric_limits<KeyType>::max());
+	}
+
+	TEST(SortByKey, int16_t_test)
+	{
+		using KeyType = int16_t;
+		SortByKeyTest<KeyType>(std::numeric_limits<KeyType>::min(), std::numeric_limits<KeyType>::max());
+	}
+
+	TEST(SortByKey, int32_t_test)
+	{
+		using KeyType = int32_t;
+		SortByKeyTest<KeyType>(std::numeric_limits<KeyType>::min(), std::numeric_limits<KeyType>::max());
+	}
+
+	TEST(SortByKey, int64_t_test)
+	{
+		using KeyType = int64_t;
+		SortByKeyTest<KeyType>(std::numeric_limits<KeyType>::min()/2, std::numeric_limits<KeyType>::max()/2);
+	}
+
+	TEST(SortByKey, float_test)
+	{
+		using KeyType = float;
+		SortByKeyTest<KeyType>(-1000.0, 1000.0);
+	}
+
+	TEST(SortByKey, double_test)
+	{
+		using KeyType = double;
+		SortByKeyTest<KeyType>(-1000.0, 1000.0);
+	}
+
+	TEST(SortByKey, skipped_passes_test)
+	{
+		// keys differ only in the lowest byte, so three of four passes are skipped
+		std::vector<uint32_t> keys = { 0x12345607, 0x12345601, 0x12345605, 0x12345601, 0x12345600 };
+		std::vector<std::string> values = { "a", "b", "c", "d", "e" };
+
+		sort_by_key(keys.begin(), keys.end(), values.begin());
+		ASSERT_TRUE((keys == std::vector<uint32_t>{ 0x12345600, 0x12345601, 0x12345601, 0x12345605, 0x12345607 }));
+		ASSERT_TRUE((values == std::vector<std::string>{ "e", "b", "d", "c", "a" }));
+	}
+
+	template<typename KeyType>
+	void SegmentedTypeTest(KeyType min, KeyType max, thread_pool& pool)
+	{
+		// segment sizes cover the insertion sort, the scratch reusing radix sort and the parallel radix sort
+		size_t large_size = large_segment_size(pool);
+		std::vector<size_t> sizes = { 0, 1, 2, 5, small_segment_size, small_segment_size + 1, 100, 1000, 0, 3,
+			large_size - 1, large_size, 7, 2 * large_size };
+		std::vector<size_t> offsets = { 0 };
+		for (size_t size : sizes)
+		{
+			offsets.push_back(offsets.back() + size);
+		}
+
+		auto get_key = [](auto& el) -> KeyType& { return el.first; };
+		Array<KeyType> data(offsets.back());
+		prepare_data<KeyType>(data, min, max);
+		Array<KeyType> expected(data);
+		for (size_t i = 0; i + 1 < offsets.size(); ++i)
+		{
+			sort<KeyType>(expected.begin() + offsets[i], expected.begin() + offsets[i + 1], get_key);
+		}
+
+		segmented_radix_sort<KeyType>(data.begin(), offsets.begin(), offsets.end(), get_key, pool);
+		check_equal(data, expected);
+	}
+
+	template<typename KeyType>
+	void SegmentedTypeTest(KeyType min, KeyType max)
+	{
+		SegmentedTypeTest<KeyType>(min, max, thread_pool::instance());
+		// force several threads regardless of the hardware
+		thread_pool pool(4);
+		SegmentedTypeTest<KeyType>(min, max, pool);
+	}
+
+	TEST(SegmentedSort, uint8_t_test)
+	{
+		using KeyType = uint8_t;
+		SegmentedTypeTest<KeyType>(std::numeric_limits<KeyType>::min(), std::numeric_limits<KeyType>::max());
+	}
+
+	TEST(SegmentedSort, uint32_t_test)
+	{
+		using KeyType = uint32_t;
+		SegmentedTypeTest<KeyType>(std::numeric_limits<KeyType>::min(), std::numeric_limits<KeyType>::max());
+	}
+
+	TEST(SegmentedSort, int16_t_test)
+	{
+		using KeyType = int16_t;
+		SegmentedTypeTest<KeyType>(std::numeric_limits<KeyType>::min(), std::numeric_limits<KeyType>::max());
+	}
+
+	TEST(SegmentedSort, int64_t_test)
+	{
+		using KeyType = int64_t;
+		SegmentedTypeTest<KeyType>(std::numeric_limits<KeyType>::min()/2, std::numeric_limits<KeyType>::max()/2);
+	}
+
+	TEST(SegmentedSort, float_test)
+	{
+		using KeyType = float;
+		SegmentedTypeTest<KeyType>(-1000.0, 1000.0);
+	}
+
+	TEST(SegmentedSort, double_test)
+	{
+		using KeyType = double;
+		SegmentedTypeTest<KeyType>(-1000.0, 1000.0);
+	}
+
+	TEST(SegmentedSort, large_segment_groups_test)
+	{
+		thread_pool pool(4);
+		// one large segment followed by many small ones
+		std::vector<size_t> offsets = { 0, 8 * large_segment_size(pool) };
+		for (size_t i = 0; i < 4000; ++i)
+		{
+			offsets.push_back(offsets.back() + 50);
+		}
+
+		std::vector<size_t> group_begin = segment_groups(offsets.begin(), offsets.end(), pool.concurrency(), large_segment_size(pool));
+		// groups hold only the small segments, split evenly
+		size_t num_groups = group_begin.size() - 1;
+		ASSERT_EQ(num_groups, 4000 * 50 / parallel_min_chunk_size);
+		for (size_t group = 0; group < num_groups; ++group)
+		{
+			size_t group_segments = group_begin[group + 1] - group_begin[group];
+			ASSERT_TRUE(group_segments + 1 >= 4000 / num_groups);
+		}
+
+		using KeyType = uint32_t;
+		auto get_key = [](auto& el) -> KeyType& { return el.first; };
+		Array<KeyType> data(offsets.back());
+		prepare_data<KeyType>(data, std::numeric_limits<KeyType>::min(), std::numeric_limits<KeyType>::max());
+		Array<KeyType> expected(data);
+		for (size_t i = 0; i + 1 < offsets.size(); ++i)
+		{
+			sort<KeyType>(expected.begin() + offsets[i], expected.begin() + offsets[i + 1], get_key);
+		}
+
+		segmented_radix_sort<KeyType>(data.begin(), offsets.begin(), offsets.end(), get_key, pool);
+		check_equal(data, expected);
+	}
+
+	TEST(SegmentedSort, medium_segments_groups_test)
+	{
+		// segments too small to give every thread a chunk are sorted in the groups, not one by one
+		constexpr size_t segment_size = 40000;
+		std::vector<size_t> offsets = { 0 };
+		for (size_t i = 0; i < 32; ++i)
+		{
+			offsets.push_back(offsets.back() + segment_size);
+		}
+
+		constexpr size_t concurrency = 16;
+		std::vector<size_t> group_begin = segment_groups(offsets.begin(), offsets.end(),
+			concurrency, concurrency * parallel_min_chunk_size);
+		size_t num_filled_groups = 0;
+		for (size_t group = 0; group + 1 < group_begin.size(); ++group)
+		{
+			size_t group_segments = group_begin[group + 1] - group_begin[group];
+			ASSERT_TRUE(group_segments <= 1);
+			num_filled_groups += group_segments;
+		}
+		// every segment has its own group, so all threads get work
+		ASSERT_EQ(num_filled_groups, offsets.size() - 1);
+		ASSERT_TRUE(num_filled_groups >= concurrency);
+
+		using KeyType = uint32_t;
+		auto get_key = [](auto& el) -> KeyType& { return el.first; };
+		offsets.resize(17);
+		Array<KeyType> data(offsets.back());
+		prepare_data<KeyType>(data, std::numeric_limits<KeyType>::min(), std::numeric_limits<KeyType>::max());
+		Array<KeyType> expected(data);
+		for (size_t i = 0; i + 1 < offsets.size(); ++i)
+		{
+			sort<KeyType>(expected.begin() + offsets[i], expected.begin() + offsets[i + 1], get_key);
+		}
+
+		thread_pool pool(4);
+		segmented_radix_sort<KeyType>(data.begin(), offsets.begin(), offsets.end(), get_key, pool);
+		check_equal(data, expected);
+	}
+
+	TEST(SegmentedSort, primitive_test)
+	{
+		std::vector<int32_t> data = { 5, -1, 3, 9, 9, -7, 2, 0, 4, 1 };
+		std::vector<uint32_t> offsets = { 0, 3, 3, 6, 10 };
+
+		allradixsort::segmented_sort(data.begin(), offsets.begin(), offsets.end());
+		ASSERT_TRUE((data == std::vector<int32_t>{ -1, 3, 5, -7, 9, 9, 0, 1, 2, 4 }));
+	}
+
+	TEST(IndexType, selection_test)
+	{
+		size_t counter_size = 0;
+		auto get_counter_size = [&](auto index) { counter_size = sizeof(index); };
+
+		with_index_type(N, get_counter_size);
+		ASSERT_EQ(counter_size, sizeof(index_t));
+		with_index_type(std::numeric_limits<index_t>::max(), get_counter_size);
+		ASSERT_EQ(counter_size, sizeof(index_t));
+		with_index_type(size_t(std::numeric_limits<index_t>::max()) + 1, get_counter_size);
+		ASSERT_EQ(counter_size, sizeof(large_index_t));
+	}
+
+	template<typename KeyType>
+	void LargeIndexTypeTest(KeyType min, KeyType max)
+	{
+		auto get_key = [](auto& el) -> KeyType& { return el.first; };
+
+		Array<KeyType> data(N);
+		prepare_data<KeyType>(data, min, max);
+		Array<KeyType> expected(data);
+		sort<KeyType>(expected.begin(), expected.end(), get_key);
+
+		// 64 bit counters, as used for containers with more than 4G elements
+		basic_hists_vector<large_index_t> hist;
+		std::vector<std::pair<KeyType, size_t>> buffer;
+		if constexpr (traits<KeyType>::is_float) {
+			float_sort<KeyType>(data.begin(), data.end(), get_key, hist, buffer);
+		}
+		else {
+			integer_sort<KeyType>(data.begin(), data.end(), get_key, hist, buffer);
+		}
+		check_equal(data, expected);
+	}
+
+	TEST(IndexType, int32_t_test)
+	{
+		using KeyType = int32_t;
+		LargeIndexTypeTest<KeyType>(std::numeric_limits<KeyType>::min(), std::numeric_limits<KeyType>::max());
+	}
+
+	TEST(IndexType, double_test)
+	{
+		using KeyType = double;
+		LargeIndexTypeTest<KeyType>(-1000.0, 1000.0);
+	}
 }}
\ No newline at end of file